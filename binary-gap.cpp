@@ -32,10 +32,27 @@ Write an efficient algorithm for the following assumptions:
  */
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <climits>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace {
 
@@ -206,13 +223,19 @@ inline auto cto(unsigned x) // count trailing one bits
   return ctz(~x);
 }
 
-int solution(int N)
+// N as bits, once it's been checked to be in the problem's range.
+
+unsigned positive(int N)
 {
   if (N < 1) {
     throw std::out_of_range("N not a positive integer");
   }
+  return unsigned(N);
+}
 
-  auto n = unsigned(N);
+int solution(int N)
+{
+  auto n = positive(N);
 
   n >>= ctz(n); // shift out trailing zeros
   n >>= cto(n); // shift out trailing ones
@@ -228,6 +251,1014 @@ int solution(int N)
 
   return max;
 }
+
+// solution() without the loop or the exception, for any unsigned.
+// The zeros between the lowest and highest one bits are found with
+// masks, and the longest run of them is found by binary lifting: run[k]
+// has a bit set where a run of 2^k zeros starts, and the length is
+// built up from the largest power of two down, with end marking the
+// bit just past each run of len zeros found so far.  Every shift is by
+// a constant, so there's no per-lane shift count.  Declared simd, it
+// gets vector clones under the x86 vector function ABI for the ISA the
+// calling code targets (SSE2 by default, AVX2 with -mavx2, and so on),
+// and being internal only the clones this file calls are emitted.  They
+// are straight vector code, and a loop calling it can be vectorized.
+
+#if defined(__GNUC__)
+__attribute__((simd("notinbranch"), const))
+#endif
+int longest_gap(unsigned n) noexcept
+{
+  auto constexpr log_bits = 5; // 32-bit unsigned
+  static_assert(sizeof(n) * CHAR_BIT == 1u << log_bits);
+
+  auto below_top = n; // every bit at or below the highest one
+  for (auto k = 0; k < log_bits; ++k)
+    below_top |= below_top >> (1 << k);
+
+  unsigned run[log_bits];
+  run[0] = ~n & (n | -n) & below_top;
+  for (auto k = 1; k < log_bits; ++k)
+    run[k] = run[k - 1] & (run[k - 1] >> (1 << (k - 1)));
+
+  auto end = ~0u; // just past a run of len zeros
+  int len = 0;
+  for (auto k = log_bits - 1; k >= 0; --k) {
+    auto const longer = end & run[k];
+    end = longer ? longer << (1 << k) : end;
+    len += longer ? 1 << k : 0;
+  }
+  return len;
+}
+
+// Each trip around the loop in solution() is a chain of dependent
+// instructions: ctz, shift, cto, shift.  Stepping K independent values
+// in lockstep gives the processor K chains to overlap.  take(k, gap)
+// is called with each gap found in lane k.  A lane that's finished
+// holds zero; or-ing in the top bit (never set in a positive int)
+// keeps its ctz defined, and it passes a gap of zero, which neither a
+// max nor a longest-first list takes any notice of.
+
+template <std::size_t K, class Take>
+void interleaved_gaps(unsigned const* in, Take take)
+{
+  unsigned n[K];
+
+  for (auto k = std::size_t(0); k < K; ++k) {
+    n[k] = in[k];
+    n[k] >>= ctz(n[k]);
+    n[k] >>= cto(n[k]);
+  }
+
+  for (;;) {
+    unsigned live = 0;
+    for (auto k = std::size_t(0); k < K; ++k)
+      live |= n[k];
+    if (!live)
+      break;
+
+    for (auto k = std::size_t(0); k < K; ++k) {
+      int const tz = ctz(n[k] | ~(~0u >> 1));
+      take(k, n[k] ? tz : 0);
+      n[k] >>= tz;
+      n[k] >>= cto(n[k]);
+    }
+  }
+}
+
+// solution() for K values at once.
+
+template <std::size_t K>
+void solution_interleaved(unsigned const* in, int* out)
+{
+  int max[K]{};
+  interleaved_gaps<K>(in, [&](std::size_t k, int gap) {
+    max[k] = std::max(gap, max[k]);
+  });
+  for (auto k = std::size_t(0); k < K; ++k)
+    out[k] = max[k];
+}
+
+// Feeds count keys, key(i) for each i, checked positive, to lanes(n, i)
+// K at a time, and the ones left over to one(N, i).
+
+template <std::size_t K, class Key, class Lanes, class One>
+void in_lanes(std::size_t count, Key key, Lanes lanes, One one)
+{
+  auto i = std::size_t(0);
+  for (; i + K <= count; i += K) {
+    unsigned n[K];
+    for (auto k = std::size_t(0); k < K; ++k)
+      n[k] = positive(key(i + k));
+    lanes(n, i);
+  }
+  for (; i < count; ++i) {
+    one(key(i), i);
+  }
+}
+
+// solution() for each element of in, four at a time.
+
+void solutions(std::span<int const> in, std::span<int> out)
+{
+  assert(in.size() <= out.size());
+
+  auto constexpr K = std::size_t(4);
+  in_lanes<K>(
+      in.size(), [in](std::size_t i) { return in[i]; },
+      [out](unsigned const* n, std::size_t i) {
+        solution_interleaved<K>(n, &out[i]);
+      },
+      [out](int N, std::size_t i) { out[i] = solution(N); });
+}
+
+// solution() for each key of a column bit-packed K bits to a key, the
+// first key in the low bits of the first word.  The keys are pulled
+// out a few at a time straight into the interleaved kernel, so the
+// column is never unpacked into a temporary array.  With K fixed at
+// compile time every mask is a constant.
+
+template <unsigned K>
+void packed_solutions(std::span<unsigned const> packed, std::span<int> out)
+{
+  auto constexpr bits = unsigned(sizeof(unsigned) * CHAR_BIT);
+  static_assert(0 < K && K < bits, "keys must fit in a positive int");
+  assert(out.size() * K <= packed.size() * bits);
+
+  auto constexpr mask = (1u << K) - 1;
+
+  auto const key = [packed](std::size_t i) {
+    auto const bit = i * K;
+    auto const word = bit / bits;
+    auto const shift = bit % bits;
+
+    std::uint64_t window = packed[word];
+    if (shift + K > bits) // straddles into the next word
+      window |= std::uint64_t(packed[word + 1]) << bits;
+
+    return int((window >> shift) & mask);
+  };
+
+  auto constexpr lanes = std::size_t(4);
+  in_lanes<lanes>(
+      out.size(), key,
+      [out](unsigned const* n, std::size_t i) {
+        solution_interleaved<lanes>(n, &out[i]);
+      },
+      [out](int N, std::size_t i) { out[i] = solution(N); });
+}
+
+// Adds gap to top, a list of the longest gaps so far, longest first.
+// It's a compare-exchange of the gap down the list: no branches, and
+// the list small enough to live in registers.
+
+template <std::size_t M>
+void push_gap(std::array<int, M>& top, int gap)
+{
+  for (auto& t : top) {
+    auto const hi = std::max(t, gap);
+    gap = std::min(t, gap);
+    t = hi;
+  }
+}
+
+// The M longest gaps in N, longest first, padded out with zeros.  It's
+// the loop from solution() with the max replaced by push_gap().
+
+template <std::size_t M>
+std::array<int, M> top_gaps(int N)
+{
+  auto n = positive(N);
+
+  n >>= ctz(n);
+  n >>= cto(n);
+
+  std::array<int, M> top{};
+
+  while (n) {
+    int const tz = ctz(n);
+    push_gap(top, tz);
+    n >>= tz;
+    n >>= cto(n);
+  }
+
+  return top;
+}
+
+// top_gaps<M>() for each element of in, four lanes in lockstep.
+
+template <std::size_t M>
+void top_gaps(std::span<int const> in, std::span<std::array<int, M>> out)
+{
+  assert(in.size() <= out.size());
+
+  auto constexpr K = std::size_t(4);
+  in_lanes<K>(
+      in.size(), [in](std::size_t i) { return in[i]; },
+      [out](unsigned const* n, std::size_t i) {
+        std::array<int, M> top[K]{};
+        interleaved_gaps<K>(n, [&](std::size_t k, int gap) {
+          push_gap(top[k], gap);
+        });
+        std::copy(top, top + K, &out[i]);
+      },
+      [out](int N, std::size_t i) { out[i] = top_gaps<M>(N); });
+}
+
+// The number of gaps in N.  Once the trailing zeros are shifted out,
+// every gap ends in a zero bit with a one just above it.
+
+int gap_count(int N)
+{
+  auto n = positive(N);
+  n >>= ctz(n);
+  return popcnt(~n & (n >> 1));
+}
+
+struct gap_run {
+  std::size_t row; // index of the key it came from
+  int bit;         // position of its lowest zero bit
+  int length;
+};
+
+// Every gap in every key, in row order and from low bits to high
+// within a row.  The first pass counts each row's gaps and a prefix
+// sum turns the counts into offsets, so the second pass writes each
+// gap straight into its final slot.  Both passes are independent from
+// row to row and can be split across threads without any locking.
+
+std::vector<gap_run> all_gaps(std::span<int const> keys)
+{
+  std::vector<std::size_t> start(keys.size() + 1);
+  start[0] = 0;
+  std::transform_inclusive_scan(keys.begin(), keys.end(), start.begin() + 1,
+                                std::plus<>(), [](int N) {
+                                  return std::size_t(gap_count(N));
+                                });
+
+  std::vector<gap_run> gaps(start.back());
+  for (auto row = std::size_t(0); row < keys.size(); ++row) {
+    auto out = gaps.begin() + start[row];
+
+    auto n = unsigned(keys[row]);
+    int bit = ctz(n);
+    n >>= bit;
+    int ones = cto(n);
+    n >>= ones;
+    bit += ones;
+
+    while (n) {
+      int const tz = ctz(n);
+      *out++ = {row, bit, tz};
+      n >>= tz;
+      ones = cto(n);
+      n >>= ones;
+      bit += tz + ones;
+    }
+  }
+
+  return gaps;
+}
+
+// A count of values by the length of their longest binary gap.  Since
+// N is at most 31 bits, one bucket per bit position is plenty.
+
+using gap_histogram = std::array<std::size_t, sizeof(int) * CHAR_BIT>;
+
+// An index from gap length to the rows of a column of keys having that
+// gap.  It's a counting sort: one pass to histogram the gap lengths, a
+// prefix sum to find where each bucket starts, and a second pass to
+// scatter the row numbers into place.  The buckets are laid out in gap
+// order, so the rows with a gap of at least k are one contiguous run,
+// and each run is in ascending row order.  Rows are stored in 32 bits;
+// a bigger column is indexed in parts.
+
+class gap_index {
+public:
+  using row_id = std::uint32_t;
+
+  explicit gap_index(std::span<int const> keys)
+    : rows_(keys.size())
+  {
+    if (keys.size() > std::numeric_limits<row_id>::max()) {
+      throw std::length_error("too many rows for a gap_index");
+    }
+
+    std::vector<unsigned char> gaps(keys.size());
+    gap_histogram hist{};
+    for (auto row = std::size_t(0); row < keys.size(); ++row) {
+      gaps[row] = solution(keys[row]);
+      ++hist[gaps[row]];
+    }
+
+    start_[0] = 0;
+    std::inclusive_scan(hist.begin(), hist.end(), start_.begin() + 1);
+
+    auto next = start_;
+    for (auto row = std::size_t(0); row < keys.size(); ++row) {
+      rows_[next[gaps[row]]++] = row_id(row);
+    }
+  }
+
+  // Rows whose longest gap is exactly k.
+  std::span<row_id const> rows_eq(int k) const
+  {
+    k = std::clamp(k, -1, buckets);
+    return rows(k, k + 1);
+  }
+
+  // Rows whose longest gap is k or more.
+  std::span<row_id const> rows_ge(int k) const
+  {
+    return rows(k, buckets);
+  }
+
+private:
+  static auto constexpr buckets = int(std::tuple_size_v<gap_histogram>);
+
+  std::span<row_id const> rows(int lo, int hi) const
+  {
+    lo = std::clamp(lo, 0, buckets);
+    hi = std::clamp(hi, lo, buckets);
+    return {rows_.data() + start_[lo], rows_.data() + start_[hi]};
+  }
+
+  std::array<std::size_t, buckets + 1> start_;
+  std::vector<row_id> rows_;
+};
+
+// Gap histograms over hopping windows of a stream of timestamped keys.
+// Windows [w * hop, w * hop + size) overlap, so time is cut into panes
+// that evenly divide both size and hop, each key's gap is counted once
+// in its pane, and a window is the sum of its panes.  Only the panes
+// inside some window are kept, numbered consecutively, so when hop >
+// size the time between windows costs nothing, and only from the
+// earliest key seen, so the clock needn't start at zero.  A window is
+// emitted once the watermark (the promise that no earlier timestamps
+// are still to come) reaches its end, and panes no later window needs
+// are dropped.  The first watermark starts emission with the first
+// window holding a key, or the first that ends after it.  Keys
+// arriving behind the watermark are refused; until then, keys may
+// come in any order.
+
+class gap_windows {
+public:
+  gap_windows(std::uint64_t size, std::uint64_t hop)
+    : size_(size)
+    , hop_(hop)
+    , pane_(std::gcd(size, hop))
+    , panes_per_hop_(size && hop ? std::min(size, hop) / pane_ : 0)
+    , panes_per_window_(size && hop ? size / pane_ : 0)
+  {
+    if (size == 0 || hop == 0) {
+      throw std::invalid_argument("window size and hop must be positive");
+    }
+  }
+
+  bool add(std::uint64_t timestamp, int key)
+  {
+    if (timestamp < watermark_)
+      return false;
+
+    auto const gap = solution(key);
+    if (timestamp % hop_ >= size_)
+      return true; // between windows
+
+    auto const pane = pane_of(timestamp);
+    if (panes_.empty()) {
+      first_pane_ = std::max(pane, first_pane_);
+    }
+    if (pane < first_pane_) {
+      panes_.insert(panes_.begin(), first_pane_ - pane, gap_histogram{});
+      first_pane_ = pane;
+    }
+    if (pane - first_pane_ >= panes_.size())
+      panes_.resize(pane - first_pane_ + 1);
+    ++panes_[pane - first_pane_][gap];
+    return true;
+  }
+
+  // Calls emit(window_start, histogram) for each window that ends at
+  // or before watermark, in order.
+  template <class Emit>
+  void advance(std::uint64_t watermark, Emit emit)
+  {
+    if (!started_) {
+      started_ = true;
+      auto const from =
+          panes_.empty() ? watermark
+                         : std::min(pane_start(first_pane_), watermark);
+      next_window_ = from < size_ ? 0 : (from - size_) / hop_ + 1;
+    }
+    watermark_ = std::max(watermark, watermark_);
+
+    for (; next_window_ * hop_ + size_ <= watermark_; ++next_window_) {
+      auto const first = next_window_ * panes_per_hop_;
+
+      gap_histogram hist{};
+      for (auto p = std::max(first, first_pane_);
+           p < first + panes_per_window_; ++p) {
+        if (p - first_pane_ >= panes_.size())
+          break;
+        auto const& pane = panes_[p - first_pane_];
+        for (auto b = std::size_t(0); b < hist.size(); ++b)
+          hist[b] += pane[b];
+      }
+      emit(next_window_ * hop_, hist);
+
+      auto const keep = first + panes_per_hop_;
+      if (keep > first_pane_) {
+        auto const drop = std::min<std::uint64_t>(keep - first_pane_,
+                                                  panes_.size());
+        panes_.erase(panes_.begin(), panes_.begin() + drop);
+        first_pane_ = keep;
+      }
+    }
+  }
+
+private:
+  // Panes are numbered counting only the time inside windows.
+  std::uint64_t pane_of(std::uint64_t time) const
+  {
+    return (time / hop_) * panes_per_hop_ + (time % hop_) / pane_;
+  }
+
+  std::uint64_t pane_start(std::uint64_t pane) const
+  {
+    return (pane / panes_per_hop_) * hop_ + (pane % panes_per_hop_) * pane_;
+  }
+
+  std::uint64_t const size_;
+  std::uint64_t const hop_;
+  std::uint64_t const pane_;
+  std::uint64_t const panes_per_hop_;    // of the panes inside windows
+  std::uint64_t const panes_per_window_;
+
+  bool started_ = false;
+  std::uint64_t watermark_ = 0;
+  std::uint64_t next_window_ = 0;
+  std::uint64_t first_pane_ = 0; // pane number of panes_.front()
+  std::deque<gap_histogram> panes_;
+};
+
+// The runs of zeros in a string of bits, as far as they matter for
+// joining it to its neighbors: the zeros below the lowest one bit, the
+// zeros above the highest one bit, and the longest gap in between.  A
+// string of all zeros has low == high == width.
+
+struct gap_summary {
+  std::uint64_t width;
+  std::uint64_t low;
+  std::uint64_t high;
+  std::uint64_t gap;
+
+  bool empty() const { return low == width; }
+
+  // longest run of zeros, bounded by ones or not
+  std::uint64_t longest() const { return std::max({low, high, gap}); }
+};
+
+constexpr gap_summary zeros_summary(std::uint64_t width)
+{
+  return {width, width, width, 0};
+}
+
+// The summary of lo followed (in the more significant bits) by hi.
+
+gap_summary combine(gap_summary const& lo, gap_summary const& hi)
+{
+  auto const width = lo.width + hi.width;
+  if (lo.empty())
+    return {width, lo.width + hi.low, hi.high + (hi.empty() ? lo.width : 0),
+            hi.gap};
+  if (hi.empty())
+    return {width, lo.low, lo.high + hi.width, lo.gap};
+  return {width, lo.low, hi.high, std::max({lo.gap, hi.gap, lo.high + hi.low})};
+}
+
+// The same walk as solution(), keeping track of where we are so the
+// zeros left over at the top can be counted.
+
+gap_summary summarize(unsigned w)
+{
+  auto constexpr bits = unsigned(sizeof(w) * CHAR_BIT);
+
+  if (w == 0)
+    return zeros_summary(bits);
+  if (w == ~0u)
+    return {bits, 0, 0, 0}; // cto() would be ctz(0)
+
+  unsigned const low = ctz(w);
+  auto n = w >> low;
+  auto pos = low;
+
+  unsigned ones = cto(n);
+  n >>= ones;
+  pos += ones;
+
+  unsigned max = 0;
+  while (n) {
+    unsigned const tz = ctz(n);
+    max = std::max(tz, max);
+    n >>= tz;
+    ones = cto(n);
+    n >>= ones;
+    pos += tz + ones;
+  }
+
+  return {bits, low, bits - pos, max};
+}
+
+// The summary of just the low width bits, when the bits above them
+// are known to be zero.
+
+gap_summary narrow(gap_summary s, std::uint64_t width)
+{
+  auto const cut = s.width - width;
+  if (s.empty())
+    return zeros_summary(width);
+  return {width, s.low, s.high - cut, s.gap};
+}
+
+// For a stream of words (word 0 holding the lowest bits) the summary
+// of every prefix words[0..i] and of every suffix words[i..], so the
+// longest gap on either side of any word boundary is one lookup, and
+// the longest gap across it is one combine() of the two.  These are
+// inclusive scans under combine(), which is associative, so a
+// parallel scan can be swapped in without changing the results.
+
+void prefix_summaries(std::span<unsigned const> words,
+                      std::span<gap_summary> out)
+{
+  assert(words.size() <= out.size());
+  std::transform_inclusive_scan(words.begin(), words.end(), out.begin(),
+                                combine, summarize);
+}
+
+void suffix_summaries(std::span<unsigned const> words,
+                      std::span<gap_summary> out)
+{
+  assert(words.size() <= out.size());
+  std::transform_inclusive_scan(
+      words.rbegin(), words.rend(),
+      out.rbegin() + (out.size() - words.size()),
+      [](gap_summary const& hi, gap_summary const& lo) {
+        return combine(lo, hi);
+      },
+      summarize);
+}
+
+// Run statistics for each block_bits-bit block of a stream of words
+// (word 0 holding the first bits), for randomness tests like the
+// longest-run-of-ones and runs tests of NIST SP 800-22.  A block is
+// taken a word's worth at a time, the part of each word inside it cut
+// out with narrow().  The longest runs come from summaries of the bits
+// and of their complement; the runs are counted as one more than the
+// places where a bit differs from the one below it, which is a popcnt
+// per piece plus a check where pieces meet.  A partial block at the
+// end is left out, as the tests do.
+
+struct block_runs {
+  std::uint64_t longest_zeros;
+  std::uint64_t longest_ones;
+  std::uint64_t runs;
+};
+
+std::vector<block_runs> run_statistics(std::span<unsigned const> words,
+                                       std::size_t block_bits)
+{
+  assert(block_bits > 0);
+
+  auto constexpr bits = sizeof(unsigned) * CHAR_BIT;
+  auto const low_bits = [](std::size_t len) {
+    return len >= bits ? ~0u : (1u << len) - 1;
+  };
+
+  std::vector<block_runs> blocks(words.size() * bits / block_bits);
+  for (auto b = std::size_t(0); b < blocks.size(); ++b) {
+    auto zeros = zeros_summary(0);
+    auto ones = zeros_summary(0);
+    std::uint64_t changes = 0;
+    unsigned prev = 0; // last bit of the previous piece
+
+    auto const first = b * block_bits;
+    auto const end = first + block_bits;
+    for (auto pos = first; pos < end;) {
+      auto const shift = pos % bits;
+      auto const len = std::min(bits - shift, end - pos);
+      auto const mask = low_bits(len);
+      auto const piece = (words[pos / bits] >> shift) & mask;
+
+      zeros = combine(zeros, narrow(summarize(piece), len));
+      ones = combine(ones, narrow(summarize(~piece & mask), len));
+      changes += popcnt((piece ^ (piece >> 1)) & low_bits(len - 1));
+      if (pos != first)
+        changes += prev ^ (piece & 1);
+
+      prev = piece >> (len - 1);
+      pos += len;
+    }
+
+    blocks[b] = {zeros.longest(), ones.longest(), changes + 1};
+  }
+
+  return blocks;
+}
+
+// The longest run of one symbol among the first count W-bit symbols
+// packed into words, first symbol in the low bits.  Each field is
+// xor'd with the symbol, so the fields that match become zero; or-ing
+// each field down into its low bit and filling the field back out
+// leaves a mask with one bits across every match.  A run of matches is
+// then a run of ones W times as long, and the longest is found as for
+// run_statistics.  The unused fields of a last, partly filled word are
+// masked off and cut away with narrow().
+
+template <unsigned W>
+std::uint64_t longest_symbol_run(std::span<unsigned const> words,
+                                 std::size_t count, unsigned symbol)
+{
+  auto constexpr bits = unsigned(sizeof(unsigned) * CHAR_BIT);
+  static_assert(W > 0 && W <= bits && bits % W == 0);
+  assert(count <= words.size() * (bits / W));
+
+  auto constexpr field = W == bits ? ~0u : (1u << W) - 1;
+  auto constexpr low_bits = ~0u / field; // the low bit of every field
+
+  if (symbol > field) {
+    throw std::out_of_range("symbol does not fit in the field width");
+  }
+
+  auto ones = zeros_summary(0);
+  for (auto i = std::size_t(0); i * (bits / W) < count; ++i) {
+    auto x = words[i] ^ (symbol * low_bits);
+    for (auto shift = W / 2; shift; shift /= 2)
+      x |= x >> shift;
+    auto const match = (~x & low_bits) * field;
+    auto const used = unsigned(
+        std::min<std::size_t>(count - i * (bits / W), bits / W) * W);
+    auto const in_use = used == bits ? ~0u : (1u << used) - 1;
+    ones = combine(ones, narrow(summarize(~match & in_use), used));
+  }
+  return ones.longest() / W;
+}
+
+// Bit strings written as text, most significant digit first, are read
+// into words without going a character at a time.  With SSE2, sixteen
+// '0'/'1' characters are compared at once and movemask gathers the
+// result, last character in bit 0 after a bit reversal.  Hex is checked
+// and decoded eight digits at a time in a 64-bit word.  Shorter strings
+// are padded on the left with '0' first so there's only the one path.
+
+unsigned binary16(char const* p)
+{
+#if defined(__SSE2__)
+  auto const chars = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+  auto const ones = _mm_cmpeq_epi8(chars, _mm_set1_epi8('1'));
+  auto const zeros = _mm_cmpeq_epi8(chars, _mm_set1_epi8('0'));
+  if (_mm_movemask_epi8(_mm_or_si128(ones, zeros)) != 0xFFFF) {
+    throw std::invalid_argument("not a binary digit");
+  }
+
+  // movemask puts the first character in bit 0; we want it in bit 15
+  unsigned m = _mm_movemask_epi8(ones);
+  m = ((m & 0x5555) << 1) | ((m >> 1) & 0x5555);
+  m = ((m & 0x3333) << 2) | ((m >> 2) & 0x3333);
+  m = ((m & 0x0F0F) << 4) | ((m >> 4) & 0x0F0F);
+  m = ((m & 0x00FF) << 8) | ((m >> 8) & 0x00FF);
+  return m;
+#else
+  unsigned m = 0;
+  for (auto i = 0; i < 16; ++i) {
+    if (p[i] != '0' && p[i] != '1') {
+      throw std::invalid_argument("not a binary digit");
+    }
+    m = (m << 1) | (p[i] == '1');
+  }
+  return m;
+#endif
+}
+
+// Up to 32 binary digits.
+
+unsigned parse_binary(std::string_view text)
+{
+  auto constexpr digits = sizeof(unsigned) * CHAR_BIT;
+  if (text.size() > digits) {
+    throw std::out_of_range("too many binary digits");
+  }
+
+  char buf[digits];
+  std::fill(buf, buf + digits - text.size(), '0');
+  std::copy(text.begin(), text.end(), buf + digits - text.size());
+
+  return (binary16(buf) << 16) | binary16(buf + 16);
+}
+
+// Up to 8 hex digits, either case.
+
+unsigned parse_hex(std::string_view text)
+{
+  auto constexpr digits = sizeof(unsigned) * 2;
+  static_assert(digits == sizeof(std::uint64_t));
+  if (text.size() > digits) {
+    throw std::out_of_range("too many hex digits");
+  }
+
+  char buf[digits];
+  std::fill(buf, buf + digits - text.size(), '0');
+  std::copy(text.begin(), text.end(), buf + digits - text.size());
+
+  // One character per byte, first character in the low byte.  Built
+  // with shifts, not a memcpy, so it's the same on any byte order.
+  std::uint64_t x = 0;
+  for (auto i = 0u; i < digits; ++i)
+    x |= std::uint64_t(static_cast<unsigned char>(buf[i])) << (CHAR_BIT * i);
+
+  // Check every byte at once.  For a byte c below 0x80, adding 0x80 - lo
+  // sets its top bit exactly when c >= lo, and adding 0x7F - hi sets it
+  // exactly when c > hi; neither carries into the next byte.
+  auto constexpr ones = std::uint64_t(0x0101010101010101);
+  auto constexpr tops = ones * 0x80;
+  auto const in_range = [=](std::uint64_t c, unsigned lo, unsigned hi) {
+    return (c + ones * (0x80 - lo)) & ~(c + ones * (0x7F - hi)) & tops;
+  };
+  auto const digit = in_range(x, '0', '9');
+  auto const letter = in_range(x | ones * 0x20, 'a', 'f');
+  if ((x & tops) || (digit | letter) != tops) {
+    throw std::invalid_argument("not a hex digit");
+  }
+
+  // The value of '0'..'9' is the low nibble, and 'a'..'f' (or 'A'..'F')
+  // have the 0x40 bit set and are nine more than their low nibble.
+  x = (x & 0x0F0F0F0F0F0F0F0F) + ((x >> 6) & ones) * 9;
+
+  // Pack neighbors together, the earlier (more significant) digit on
+  // top: bytes into 16-bit lanes, those into 32-bit lanes, then one.
+  x = ((x & 0x000F000F000F000F) << 4) | ((x >> 8) & 0x000F000F000F000F);
+  x = ((x & 0x000000FF000000FF) << 8) | ((x >> 16) & 0x000000FF000000FF);
+  x = ((x & 0x000000000000FFFF) << 16) | ((x >> 32) & 0x000000000000FFFF);
+  return unsigned(x);
+}
+
+// The summary of a bit string of any length written as text, parsed a
+// word at a time from the least significant end.
+
+template <std::size_t Digits, unsigned (*Parse)(std::string_view)>
+gap_summary summarize_text(std::string_view text)
+{
+  auto constexpr bits_per_digit = sizeof(unsigned) * CHAR_BIT / Digits;
+
+  auto s = zeros_summary(0);
+  while (!text.empty()) {
+    auto const n = std::min(Digits, text.size());
+    auto const word = Parse(text.substr(text.size() - n));
+    s = combine(s, narrow(summarize(word), n * bits_per_digit));
+    text.remove_suffix(n);
+  }
+  return s;
+}
+
+gap_summary summarize_binary(std::string_view text)
+{
+  return summarize_text<sizeof(unsigned) * CHAR_BIT, parse_binary>(text);
+}
+
+gap_summary summarize_hex(std::string_view text)
+{
+  return summarize_text<sizeof(unsigned) * 2, parse_hex>(text);
+}
+
+// A set of unsigned ints that always knows its longest run of missing
+// values.  It's a trie of 32-way nodes over one bit per value: each
+// node keeps the summary of the values under it and a word with a bit
+// for each child that isn't empty.  A change only re-summarizes the
+// nodes on its path, and ctz() over the occupancy word steps from one
+// non-empty child to the next, so the empty spans in between cost
+// nothing.  Nodes are allocated as values arrive and freed when they
+// empty out.
+
+class gap_set {
+public:
+  gap_set() { root_.summary = zeros_summary(width(levels)); }
+
+  bool contains(unsigned x) const { return contains(root_, x); }
+
+  void insert(unsigned x) { insert(root_, x); }
+  void erase(unsigned x) { erase(root_, x); }
+
+  // Longest run of consecutive values not in the set.
+  std::uint64_t max_gap() const { return root_.summary.longest(); }
+
+  gap_summary const& summary() const { return root_.summary; }
+
+private:
+  static auto constexpr value_bits = unsigned(sizeof(unsigned) * CHAR_BIT);
+  static auto constexpr level_bits = 5u; // log2 of the 32-way fan out
+  static_assert(value_bits == 1u << level_bits);
+
+  // Level 0 is a word of bits, level 1 the leaves holding those words,
+  // and the root is the first level that covers every unsigned.
+  static auto constexpr levels = (value_bits - 1) / level_bits;
+
+  // The two kinds of node carry only what they use: a leaf its words,
+  // an inner node its pointers to the level below.
+
+  struct leaf {
+    static auto constexpr level = 1u;
+    gap_summary summary;
+    unsigned occupied = 0;
+    std::array<unsigned, 32> word{};
+  };
+
+  template <unsigned Level>
+  struct inner {
+    static auto constexpr level = Level;
+    using child_type = std::conditional_t<Level == 2, leaf, inner<Level - 1>>;
+    gap_summary summary;
+    unsigned occupied = 0;
+    std::array<std::unique_ptr<child_type>, 32> child{};
+  };
+
+  static constexpr std::uint64_t width(unsigned level)
+  {
+    return std::uint64_t(1) << std::min(level_bits * (level + 1), value_bits);
+  }
+
+  static constexpr unsigned index(unsigned x, unsigned level)
+  {
+    return (x >> (level_bits * level)) & (value_bits - 1);
+  }
+
+  static constexpr unsigned bit(unsigned x)
+  {
+    return 1u << (x & (value_bits - 1));
+  }
+
+  static gap_summary child_summary(leaf const& n, unsigned i)
+  {
+    return summarize(n.word[i]);
+  }
+
+  template <unsigned Level>
+  static gap_summary child_summary(inner<Level> const& n, unsigned i)
+  {
+    return n.child[i]->summary;
+  }
+
+  template <class Node>
+  static void resummarize(Node& n)
+  {
+    auto const child_width = width(Node::level - 1);
+    auto const fan_out = width(Node::level) / child_width;
+
+    auto s = zeros_summary(0);
+    auto next = std::uint64_t(0); // first child not yet folded in
+    for (auto occ = n.occupied; occ; occ &= occ - 1) {
+      auto const i = unsigned(ctz(occ));
+      s = combine(s, zeros_summary((i - next) * child_width));
+      s = combine(s, child_summary(n, i));
+      next = i + 1;
+    }
+    n.summary = combine(s, zeros_summary((fan_out - next) * child_width));
+  }
+
+  static bool contains(leaf const& n, unsigned x)
+  {
+    return n.word[index(x, 1)] & bit(x);
+  }
+
+  template <unsigned Level>
+  static bool contains(inner<Level> const& n, unsigned x)
+  {
+    auto const& child = n.child[index(x, Level)];
+    return child && contains(*child, x);
+  }
+
+  static void insert(leaf& n, unsigned x)
+  {
+    auto const i = index(x, 1);
+    n.word[i] |= bit(x);
+    n.occupied |= 1u << i;
+    resummarize(n);
+  }
+
+  template <unsigned Level>
+  static void insert(inner<Level>& n, unsigned x)
+  {
+    using child_type = typename inner<Level>::child_type;
+    auto const i = index(x, Level);
+    if (!n.child[i])
+      n.child[i] = std::make_unique<child_type>();
+    insert(*n.child[i], x);
+    n.occupied |= 1u << i;
+    resummarize(n);
+  }
+
+  static void erase(leaf& n, unsigned x)
+  {
+    auto const i = index(x, 1);
+    n.word[i] &= ~bit(x);
+    if (!n.word[i])
+      n.occupied &= ~(1u << i);
+    resummarize(n);
+  }
+
+  template <unsigned Level>
+  static void erase(inner<Level>& n, unsigned x)
+  {
+    auto const i = index(x, Level);
+    if (!n.child[i])
+      return;
+
+    erase(*n.child[i], x);
+    if (!n.child[i]->occupied) {
+      n.child[i].reset();
+      n.occupied &= ~(1u << i);
+    }
+    resummarize(n);
+  }
+
+  inner<levels> root_;
+};
+
+// A column of keys that keeps the histogram of their gap lengths.
+// Each block of keys has its own histogram, and writes through set()
+// only mark their block dirty, so bringing the total up to date costs
+// in proportion to the blocks written since last time, not to the
+// size of the column.
+
+class gap_column {
+public:
+  static auto constexpr block_size = std::size_t(4096);
+
+  explicit gap_column(std::vector<int> keys)
+    : keys_(std::move(keys))
+    , block_hist_((keys_.size() + block_size - 1) / block_size)
+    , is_dirty_(block_hist_.size(), true)
+  {
+    for (auto key : keys_)
+      positive(key);
+    dirty_.resize(block_hist_.size());
+    std::iota(dirty_.begin(), dirty_.end(), 0);
+  }
+
+  std::size_t size() const { return keys_.size(); }
+  int operator[](std::size_t i) const { return keys_[i]; }
+
+  void set(std::size_t i, int key)
+  {
+    positive(key);
+    keys_[i] = key;
+    auto const block = i / block_size;
+    if (!is_dirty_[block]) {
+      is_dirty_[block] = true;
+      dirty_.push_back(block);
+    }
+  }
+
+  gap_histogram const& histogram()
+  {
+    std::array<int, block_size> gaps;
+    for (auto block : dirty_) {
+      auto& hist = block_hist_[block];
+      for (auto b = 0u; b < hist.size(); ++b)
+        total_[b] -= hist[b];
+
+      auto const first = block * block_size;
+      auto const n = std::min(block_size, keys_.size() - first);
+      solutions({keys_.data() + first, n}, gaps);
+
+      hist = {};
+      for (auto i = 0u; i < n; ++i)
+        ++hist[gaps[i]];
+      for (auto b = 0u; b < hist.size(); ++b)
+        total_[b] += hist[b];
+
+      is_dirty_[block] = false;
+    }
+    dirty_.clear();
+    return total_;
+  }
+
+  // Longest gap in the whole column.
+  int max_gap()
+  {
+    auto const& hist = histogram();
+    for (auto b = int(hist.size()) - 1; b > 0; --b) {
+      if (hist[b])
+        return b;
+    }
+    return 0;
+  }
+
+private:
+  std::vector<int> keys_;
+  std::vector<gap_histogram> block_hist_;
+  std::vector<bool> is_dirty_;
+  std::vector<std::size_t> dirty_;
+  gap_histogram total_{};
+};
 } // namespace
 
 int main()
@@ -315,5 +1346,391 @@ int main()
 
   assert(count_gap_zeros(0x7FFFFFF9) == 2);
 
+  std::vector<int> batch;
+  for (auto i = 1; i < 0x1'00'00; ++i) {
+    batch.push_back(i);
+    batch.push_back(i * 0x7FFF);
+    batch.push_back(INT_MAX - i);
+  }
+  batch.push_back(0x40000001);
+  std::vector<int> batch_out(batch.size());
+  solutions(batch, batch_out);
+  for (auto i = 0u; i < batch.size(); ++i) {
+    assert(batch_out[i] == solution(batch[i]));
+    assert(int(summarize(batch[i]).gap) == batch_out[i]);
+  }
+
+  std::vector<int> simd_out(batch.size());
+  std::transform(batch.begin(), batch.end(), simd_out.begin(),
+                 [](int N) { return longest_gap(N); });
+  assert(simd_out == batch_out);
+  assert(longest_gap(0) == 0);
+  assert(longest_gap(~0u) == 0);
+  assert(longest_gap(0x80000001) == 30);
+  assert(longest_gap(0x80000000) == 0);
+  assert(longest_gap(0xA0000005) == 26);
+
+  int const some_keys[]{529, 9, 15, 1041};
+  auto const some_gaps = all_gaps(some_keys);
+  assert(some_gaps.size() == 5);
+  auto const is_run = [](gap_run const& g, std::size_t row, int bit,
+                         int length) {
+    return g.row == row && g.bit == bit && g.length == length;
+  };
+  assert(is_run(some_gaps[0], 0, 1, 3));
+  assert(is_run(some_gaps[1], 0, 5, 4));
+  assert(is_run(some_gaps[2], 1, 1, 2));
+  assert(is_run(some_gaps[3], 3, 1, 3));
+  assert(is_run(some_gaps[4], 3, 5, 5));
+
+  auto const batch_gaps = all_gaps(batch);
+  std::vector<int> longest(batch.size());
+  for (auto const& g : batch_gaps) {
+    assert(((unsigned(batch[g.row]) >> g.bit) & ((1u << g.length) - 1)) == 0);
+    longest[g.row] = std::max(longest[g.row], g.length);
+  }
+  assert(longest == batch_out);
+  assert(gap_count(0x55555555) == 15);
+
+  std::vector<std::array<int, 3>> batch_top(batch.size());
+  top_gaps<3>(batch, batch_top);
+  for (auto i = 0u; i < batch.size(); ++i) {
+    auto const top = top_gaps<3>(batch[i]);
+    assert(batch_top[i] == top);
+    assert(top[0] == batch_out[i]);
+    assert(top[0] >= top[1] && top[1] >= top[2]);
+  }
+  assert((top_gaps<3>(0b1000100101) == std::array{3, 2, 1}));
+  assert((top_gaps<3>(529) == std::array{4, 3, 0}));
+  assert((top_gaps<2>(0b101000100101) == std::array{3, 2}));
+  assert((top_gaps<4>(0b10100101) == std::array{2, 1, 1, 0}));
+  assert((top_gaps<1>(32) == std::array{0}));
+  assert(gap_count(0x7FFFFFFF) == 0);
+
+  assert(summarize(0).longest() == 32);
+  assert(summarize(~0u).longest() == 0);
+  assert(summarize(0x80000000).low == 31 && summarize(0x80000000).high == 0);
+  assert(summarize(0x00F00F00).low == 8 && summarize(0x00F00F00).high == 8);
+  assert(summarize(0x00F00F00).gap == 8);
+
+  unsigned const stream[]{0x00000001, 0, 0x00000100, 0x80000000};
+  gap_summary prefix[std::size(stream)];
+  gap_summary suffix[std::size(stream)];
+  prefix_summaries(stream, prefix);
+  suffix_summaries(stream, suffix);
+  assert(prefix[0].gap == 0 && prefix[1].gap == 0);
+  assert(prefix[2].gap == 71 && prefix[3].gap == 71);
+  assert(prefix[3].width == 128 && prefix[3].low == 0 && prefix[3].high == 0);
+  assert(suffix[3].gap == 0 && suffix[2].gap == 54 && suffix[1].gap == 54);
+  assert(suffix[1].low == 40 && suffix[0].gap == 71);
+
+  // Ten tick windows every two ticks, checked against counting each
+  // window's keys from scratch.
+  gap_windows windows(10, 2);
+  auto const key_at = [&](std::uint64_t t) { return batch[t % batch.size()]; };
+  auto constexpr ticks = 1000u, per_tick = 3u;
+  std::vector<std::uint64_t> emitted;
+  for (auto t = 0u; t < ticks; ++t) {
+    for (auto e = 0u; e < per_tick; ++e)
+      assert(windows.add(t, key_at(t * per_tick + e)));
+    windows.advance(t + 1, [&](std::uint64_t start, gap_histogram const& hist) {
+      gap_histogram expect{};
+      for (auto u = start; u < start + 10; ++u)
+        for (auto e = 0u; e < per_tick; ++e)
+          ++expect[solution(key_at(u * per_tick + e))];
+      assert(hist == expect);
+      emitted.push_back(start);
+    });
+  }
+  assert(!windows.add(ticks - 2, 1));
+  assert(emitted.size() == (ticks - 10) / 2 + 1);
+  assert(emitted.front() == 0 && emitted.back() == ticks - 10);
+
+  // One tick windows every ten ticks, at real clock times.
+  gap_windows sparse(1, 10);
+  auto constexpr epoch = std::uint64_t(1'700'000'000);
+  std::vector<std::pair<std::uint64_t, gap_histogram>> sparse_out;
+  auto const collect = [&](std::uint64_t start, gap_histogram const& hist) {
+    sparse_out.emplace_back(start, hist);
+  };
+  sparse.advance(epoch, collect);
+  assert(sparse_out.empty());
+  assert(sparse.add(epoch + 3, 9)); // between windows
+  assert(sparse.add(epoch + 10, 9));
+  assert(sparse.add(epoch + 10, 529));
+  assert(sparse.add(epoch + 20, 9));
+  assert(sparse.add(epoch + 15, 32)); // between windows
+  sparse.advance(epoch + 21, collect);
+  assert(sparse_out.size() == 3);
+  assert(sparse_out[0].first == epoch);
+  assert(sparse_out[0].second == gap_histogram{});
+  assert(sparse_out[1].first == epoch + 10);
+  assert(sparse_out[1].second[2] == 1 && sparse_out[1].second[4] == 1);
+  assert(sparse_out[2].first == epoch + 20 && sparse_out[2].second[2] == 1);
+  assert(!sparse.add(epoch + 20, 9));
+
+  gap_windows late_start(10, 2);
+  auto late_emitted = 0u;
+  late_start.advance(2'000'000, [&](std::uint64_t, gap_histogram const&) {
+    ++late_emitted;
+  });
+  assert(late_emitted == 0);
+  assert(late_start.add(2'000'005, 9));
+  assert(!late_start.add(1'999'999, 9));
+  late_start.advance(2'000'012, [&](std::uint64_t start,
+                                    gap_histogram const& hist) {
+    // every window ending after the first watermark
+    assert(start == 1'999'992 + 2 * late_emitted);
+    assert(hist[2] == (start + 10 > 2'000'005 && start <= 2'000'005));
+    ++late_emitted;
+  });
+  assert(late_emitted == 6);
+
+  // Keys out of order before the first watermark all count, in every
+  // window holding them.
+  gap_windows unordered(10, 2);
+  std::uint64_t const times[]{100, 99, 93, 105};
+  for (auto t : times)
+    assert(unordered.add(t, 9));
+  auto unordered_emitted = 0u;
+  unordered.advance(120, [&](std::uint64_t start, gap_histogram const& hist) {
+    assert(start == 84 + 2 * unordered_emitted);
+    std::size_t expect = 0;
+    for (auto t : times)
+      expect += start <= t && t < start + 10;
+    assert(hist[2] == expect);
+    ++unordered_emitted;
+  });
+  assert(unordered_emitted == 14);
+
+  std::vector<unsigned> words(batch.begin(), batch.end());
+  for (auto i = 0u; i < words.size(); i += 3)
+    words[i] = 0; // make some gaps run across words
+  std::vector<gap_summary> word_prefix(words.size());
+  std::vector<gap_summary> word_suffix(words.size());
+  prefix_summaries(words, word_prefix);
+  suffix_summaries(words, word_suffix);
+  for (auto i = 1u; i < words.size(); ++i) {
+    auto const whole = combine(word_prefix[i - 1], word_suffix[i]);
+    assert(whole.gap == word_prefix.back().gap);
+    assert(whole.gap == word_suffix.front().gap);
+  }
+
+  assert(parse_binary("1000010001") == 529);
+  assert(parse_binary("") == 0);
+  assert(parse_binary("10000000000000000000000000000001") == 0x80000001);
+  assert(parse_binary("1111111111111111") == 0xFFFF);
+  assert(parse_hex("211") == 529);
+  assert(parse_hex("DeadBeef") == 0xDEADBEEF);
+  assert(parse_hex("0") == 0);
+  assert(parse_hex("09afAF") == 0x09AFAF);
+  for (auto const bad : {"102", "1 1", "x"}) {
+    auto threw = false;
+    try {
+      parse_binary(bad);
+    }
+    catch (std::invalid_argument const&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+  for (auto const bad : {"g", "0x1", "12345678 ", "9:", "/", "@", "`", "G",
+                         "\xC1", "a\x86"}) {
+    auto threw = false;
+    try {
+      parse_hex(bad);
+    }
+    catch (std::exception const&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  assert(summarize_binary("1000010001").gap == 4);
+  assert(summarize_binary("0001").high == 3);
+  assert(summarize_hex("800000000000000000001").gap == 82);
+  assert(summarize_hex("800000000000000000001").width == 84);
+  assert(summarize_hex("00000").longest() == 20);
+  std::string long_binary = "1";
+  long_binary.append(100, '0');
+  long_binary.append("1001");
+  auto const long_summary = summarize_binary(long_binary);
+  assert(long_summary.gap == 100 && long_summary.width == 105);
+
+  unsigned const two_words[]{0xFFFF0000, 0x0000000F, 0xFFFFFFFF};
+  auto const two_runs = run_statistics(two_words, 64);
+  assert(two_runs.size() == 1);
+  assert(two_runs[0].longest_zeros == 28 && two_runs[0].longest_ones == 20);
+  assert(two_runs[0].runs == 3);
+
+  // The SP 800-22 block sizes, and some that straddle words oddly.
+  for (auto const block_bits : {8u, 128u, 10'000u, 100u, 33u}) {
+    auto const block_stats = run_statistics(words, block_bits);
+    assert(block_stats.size() == words.size() * 32 / block_bits);
+    for (auto b = std::size_t(0); b < block_stats.size(); ++b) {
+      std::uint64_t longest[2]{}, run = 0, runs = 0;
+      int prev = -1;
+      for (auto i = b * block_bits; i < (b + 1) * block_bits; ++i) {
+        int const bit = (words[i / 32] >> (i % 32)) & 1;
+        run = bit == prev ? run + 1 : 1;
+        runs += bit != prev;
+        longest[bit] = std::max(longest[bit], run);
+        prev = bit;
+      }
+      assert(block_stats[b].longest_zeros == longest[0]);
+      assert(block_stats[b].longest_ones == longest[1]);
+      assert(block_stats[b].runs == runs);
+    }
+  }
+
+  auto const check_symbol_runs = [&](auto width) {
+    auto constexpr W = decltype(width)::value;
+    auto constexpr per_word = 32 / W;
+    for (auto symbol = 0u; symbol < (1u << W); ++symbol) {
+      std::uint64_t longest = 0, run = 0;
+      for (auto i = 0u; i < words.size() * per_word; ++i) {
+        auto const s = (words[i / per_word] >> (i % per_word * W)) &
+                       ((1u << W) - 1);
+        run = s == symbol ? run + 1 : 0;
+        longest = std::max(longest, run);
+      }
+      assert(longest_symbol_run<W>(words, words.size() * per_word, symbol) ==
+             longest);
+    }
+  };
+  check_symbol_runs(std::integral_constant<unsigned, 1>());
+  check_symbol_runs(std::integral_constant<unsigned, 2>());
+  check_symbol_runs(std::integral_constant<unsigned, 4>());
+
+  unsigned const genome[]{0x000000E4, 0x00000000}; // ACGT then all A
+  assert(longest_symbol_run<2>(genome, 32, 0) == 28);
+  assert(longest_symbol_run<2>(genome, 32, 3) == 1);
+  assert(longest_symbol_run<8>(genome, 8, 0) == 7);
+  assert(longest_symbol_run<8>(genome, 8, 0xE4) == 1);
+  assert(longest_symbol_run<32>(genome, 2, 0) == 1);
+
+  unsigned const three_c[]{0b010101}; // CCC, and nothing after
+  assert(longest_symbol_run<2>(three_c, 3, 1) == 3);
+  assert(longest_symbol_run<2>(three_c, 3, 0) == 0);
+  assert(longest_symbol_run<2>(genome, 20, 0) == 16);
+  assert(longest_symbol_run<2>(genome, 0, 0) == 0);
+
+  gap_set live;
+  auto constexpr universe = std::uint64_t(1) << 32;
+  assert(live.max_gap() == universe);
+  live.insert(0);
+  live.insert(~0u);
+  assert(live.max_gap() == universe - 2);
+  live.insert(1000);
+  assert(live.max_gap() == universe - 1002);
+  assert(live.contains(1000) && !live.contains(1001));
+  live.erase(1000);
+  live.erase(1000);
+  assert(live.max_gap() == universe - 2);
+  live.erase(~0u);
+  assert(live.max_gap() == universe - 1);
+  live.erase(0);
+  assert(live.max_gap() == universe);
+
+  // Churn in the low end and check against a sorted copy.
+  std::vector<bool> member(1 << 14);
+  unsigned lcg = 1;
+  for (auto op = 0; op < 20'000; ++op) {
+    lcg = lcg * 1664525 + 1013904223;
+    auto const x = (lcg >> 8) % member.size();
+    if (lcg & 1) {
+      live.insert(x);
+      member[x] = true;
+    }
+    else {
+      live.erase(x);
+      member[x] = false;
+    }
+    if (op % 97 == 0) {
+      std::uint64_t max = 0, run = 0;
+      for (auto v : member) {
+        run = v ? 0 : run + 1;
+        max = std::max(max, run);
+      }
+      max = std::max(max, run + universe - member.size());
+      assert(live.max_gap() == max);
+    }
+  }
+
+  gap_column column(batch);
+  auto const full_histogram = [&] {
+    gap_histogram hist{};
+    for (auto i = 0u; i < column.size(); ++i)
+      ++hist[solution(column[i])];
+    return hist;
+  };
+  assert(column.histogram() == full_histogram());
+  assert(column.max_gap() == 29); // 0x40000001
+  column.set(batch.size() - 1, 1);
+  column.set(7, 0b100000000000000000000001);
+  column.set(8, 0b100000000000000000000101);
+  assert(column.histogram() == full_histogram());
+  assert(column.max_gap() == 22);
+
+  auto threw_in_constructor = false;
+  try {
+    gap_column bad(std::vector<int>{5, 0, 7});
+  }
+  catch (std::out_of_range const&) {
+    threw_in_constructor = true;
+  }
+  assert(threw_in_constructor);
+
+  auto const check_packed = [&](auto width) {
+    auto constexpr K = decltype(width)::value;
+    std::vector<unsigned> packed((batch.size() * K + 31) / 32);
+    std::vector<int> expect(batch.size());
+    for (auto i = 0u; i < batch.size(); ++i) {
+      auto N = unsigned(batch[i]) & ((1u << K) - 1);
+      N = N ? N : 1;
+      expect[i] = solution(N);
+      auto const bit = std::size_t(i) * K;
+      auto const window = std::uint64_t(N) << (bit % 32);
+      packed[bit / 32] |= unsigned(window);
+      if (bit % 32 + K > 32)
+        packed[bit / 32 + 1] |= unsigned(window >> 32);
+    }
+    std::vector<int> got(batch.size());
+    packed_solutions<K>(packed, got);
+    assert(got == expect);
+  };
+  check_packed(std::integral_constant<unsigned, 17>());
+  check_packed(std::integral_constant<unsigned, 23>());
+  check_packed(std::integral_constant<unsigned, 31>());
+  check_packed(std::integral_constant<unsigned, 8>());
+
+  unsigned const packed_zero[]{0x00000FFF};
+  int packed_out[2];
+  auto threw = false;
+  try {
+    packed_solutions<12>(packed_zero, packed_out);
+  }
+  catch (std::out_of_range const&) {
+    threw = true;
+  }
+  assert(threw);
+
+  int const keys[]{9, 529, 15, 32, 1041, 20, 0b1001, 0x7FFFFFFF};
+  gap_index const idx(keys);
+
+  auto const eq2 = idx.rows_eq(2);
+  assert(eq2.size() == 2 && eq2[0] == 0 && eq2[1] == 6);
+  auto const eq0 = idx.rows_eq(0);
+  assert(eq0.size() == 3 && eq0[0] == 2 && eq0[1] == 3 && eq0[2] == 7);
+  auto const ge4 = idx.rows_ge(4);
+  assert(ge4.size() == 2 && ge4[0] == 1 && ge4[1] == 4);
+  assert(idx.rows_ge(0).size() == std::size(keys));
+  assert(idx.rows_ge(6).empty());
+  assert(idx.rows_eq(-1).empty());
+  assert(idx.rows_eq(99).empty());
+  assert(idx.rows_eq(INT_MAX).empty() && idx.rows_ge(INT_MAX).empty());
+  assert(idx.rows_eq(INT_MIN).empty());
+  assert(idx.rows_ge(INT_MIN).size() == std::size(keys));
+
   return 0;
 }